@@ -9,5 +9,6 @@ struct Allocator {
     virtual const char* name() const = 0;
     virtual size_t getUsedMemory() const = 0;
     virtual size_t getTotalMemory() const = 0;
+    virtual size_t getBlockSize(void* ptr) const = 0;
 };
 
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "allocator.h"
+#include "deferred_free_allocator.h"
+#include "tlsf_allocator.h"
+
+struct AllocatorOptions {
+    size_t tlsfSlLog2 = TlsfAllocator::DEFAULT_SL_LOG2;
+    size_t deferredBatchSize = DeferredFreeAllocator::DEFAULT_BATCH_SIZE;
+    size_t deferredMaxPendingBytes = DeferredFreeAllocator::DEFAULT_MAX_PENDING_BYTES;
+};
+
+struct AllocatorEntry {
+    const char* key;
+    bool usesPool;
+    Allocator* (*create)(void* realMemory, size_t memorySize, const AllocatorOptions& options);
+};
+
+const std::vector<AllocatorEntry>& allocatorRegistry();
+const AllocatorEntry* findAllocator(const std::string& key);
@@ -1,26 +1,147 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <ostream>
 #include <string>
+#include <vector>
 
 #include "allocator.h"
+#include "allocator_registry.h"
+
+struct BenchmarkConfig {
+    size_t memorySize = 64 * 1024 * 1024;
+    size_t numOperations = 100000;
+    size_t minSize = 16;
+    size_t maxSize = 4096;
+    size_t repeats = 5;
+    uint32_t seed = 42;
+    AllocatorOptions allocatorOptions;
+};
 
 struct BenchmarkResult {
     std::string allocatorName;
     double avgAllocTimeNs;
     double avgFreeTimeNs;
+    double allocP99Ns;
+    double allocP999Ns;
+    double freeP99Ns;
+    double freeP999Ns;
     double utilizationFactor;
     size_t successfulAllocs;
     size_t failedAllocs;
 };
 
+struct LocalityResult {
+    std::string allocatorName;
+    size_t objects;
+    size_t failedAllocs;
+    double writeNsPerObject;
+    double readNsPerObject;
+    double chaseNsPerObject;
+    double pagesPerObject;
+    double avgStrideBytes;
+    bool cacheCountersAvailable;
+    bool tlbCountersAvailable;
+    double writeCacheMisses;
+    double writeTlbMisses;
+    double readCacheMisses;
+    double readTlbMisses;
+    double chaseCacheMisses;
+    double chaseTlbMisses;
+};
+
+struct MetricStats {
+    double mean = 0.0;
+    double stddev = 0.0;
+    double ci95 = 0.0;
+};
+
+struct BenchmarkSummary {
+    std::string key;
+    std::string allocatorName;
+    size_t runs = 0;
+    MetricStats allocTimeNs;
+    MetricStats freeTimeNs;
+    MetricStats allocP99Ns;
+    MetricStats allocP999Ns;
+    MetricStats freeP99Ns;
+    MetricStats freeP999Ns;
+    MetricStats utilizationFactor;
+    MetricStats successfulAllocs;
+    MetricStats failedAllocs;
+};
+
+struct LocalitySummary {
+    std::string key;
+    std::string allocatorName;
+    size_t runs = 0;
+    bool cacheCountersAvailable = false;
+    bool tlbCountersAvailable = false;
+    MetricStats objects;
+    MetricStats failedAllocs;
+    MetricStats writeNsPerObject;
+    MetricStats readNsPerObject;
+    MetricStats chaseNsPerObject;
+    MetricStats pagesPerObject;
+    MetricStats avgStrideBytes;
+    MetricStats writeCacheMisses;
+    MetricStats writeTlbMisses;
+    MetricStats readCacheMisses;
+    MetricStats readTlbMisses;
+    MetricStats chaseCacheMisses;
+    MetricStats chaseTlbMisses;
+};
+
+struct Regression {
+    std::string key;
+    std::string metric;
+    double baseline;
+    double current;
+};
+
 class Benchmark {
 public:
     static BenchmarkResult runBenchmark(Allocator* allocator, 
                                          size_t numOperations,
                                          size_t minSize, 
                                          size_t maxSize);
-    
-    static void comparePrint(const BenchmarkResult& r1, const BenchmarkResult& r2);
-};
+    static BenchmarkResult runBenchmark(Allocator* allocator,
+                                         size_t numOperations,
+                                         size_t minSize,
+                                         size_t maxSize,
+                                         uint32_t seed);
 
+    static LocalityResult runLocality(Allocator* allocator,
+                                      size_t numOperations,
+                                      size_t minSize,
+                                      size_t maxSize,
+                                      uint32_t seed);
+
+    static BenchmarkSummary runRepeated(const AllocatorEntry& entry, const BenchmarkConfig& config);
+    static BenchmarkSummary summarize(const std::string& key, const std::vector<BenchmarkResult>& runs);
+
+    static size_t fitLocalityOperations(const std::vector<const AllocatorEntry*>& entries,
+                                        const BenchmarkConfig& config);
+    static LocalitySummary runLocalityRepeated(const AllocatorEntry& entry, const BenchmarkConfig& config);
+    static LocalitySummary summarizeLocality(const std::string& key, const std::vector<LocalityResult>& runs);
+
+    static void comparePrint(const std::vector<BenchmarkSummary>& summaries);
+    static void comparePrint(const std::vector<LocalitySummary>& summaries);
+    static void writeJson(std::ostream& out, const BenchmarkConfig& config,
+                          const std::vector<BenchmarkSummary>& summaries);
+    static void writeJson(std::ostream& out, const BenchmarkConfig& config,
+                          const std::vector<LocalitySummary>& summaries);
+    static void writeCsv(std::ostream& out, const BenchmarkConfig& config,
+                         const std::vector<BenchmarkSummary>& summaries);
+    static void writeCsv(std::ostream& out, const BenchmarkConfig& config,
+                         const std::vector<LocalitySummary>& summaries);
+
+    static bool loadBaseline(const std::string& path, BenchmarkConfig& config,
+                             std::vector<BenchmarkSummary>& baseline);
+    static bool sameWorkload(const BenchmarkConfig& a, const BenchmarkConfig& b);
+    static std::vector<Regression> findRegressions(const std::vector<BenchmarkSummary>& current,
+                                                   const std::vector<BenchmarkSummary>& baseline,
+                                                   double threshold,
+                                                   std::vector<std::string>& missing);
+};
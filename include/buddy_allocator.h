@@ -15,6 +15,7 @@ public:
     const char* name() const override { return "Buddy Allocator"; }
     size_t getUsedMemory() const override { return usedMemory_; }
     size_t getTotalMemory() const override { return totalSize_; }
+    size_t getBlockSize(void* ptr) const override;
 
 private:
     static constexpr size_t MIN_BLOCK_SIZE = 32;
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "allocator.h"
+
+class DeferredFreeAllocator : public Allocator {
+public:
+    static constexpr size_t DEFAULT_BATCH_SIZE = 256;
+    static constexpr size_t DEFAULT_MAX_PENDING_BYTES = 4 * 1024 * 1024;
+    static constexpr size_t RELEASE_CHUNK_SIZE = 16;
+    static constexpr size_t CREDIT_CHUNKS = 16;
+
+    DeferredFreeAllocator(Allocator* inner,
+                          size_t batchSize = DEFAULT_BATCH_SIZE,
+                          size_t maxPendingBytes = DEFAULT_MAX_PENDING_BYTES,
+                          bool backgroundReclaimer = true);
+    ~DeferredFreeAllocator() override;
+
+    DeferredFreeAllocator(const DeferredFreeAllocator&) = delete;
+    DeferredFreeAllocator& operator=(const DeferredFreeAllocator&) = delete;
+
+    void* alloc(size_t size) override;
+    void free(void* ptr) override;
+    const char* name() const override { return name_.c_str(); }
+    size_t getUsedMemory() const override;
+    size_t getTotalMemory() const override { return inner_->getTotalMemory(); }
+    size_t getBlockSize(void* ptr) const override { return inner_->getBlockSize(ptr); }
+
+    void quiesce();
+    size_t getPendingMemory() const { return pendingBytes_.load(std::memory_order_relaxed); }
+
+private:
+    struct ThreadBuffer;
+    struct ThreadBuffers;
+
+    struct Batch {
+        std::vector<void*> pointers;
+        Batch* next;
+    };
+
+    static thread_local ThreadBuffers threadBuffers_;
+
+    Allocator* inner_;
+    std::string name_;
+    size_t batchSize_;
+    size_t maxPendingBytes_;
+    size_t creditChunk_;
+    uint64_t id_;
+
+    mutable std::mutex allocMutex_;
+    mutable std::atomic<int> allocWaiters_;
+    std::atomic<size_t> pendingBytes_;
+    std::mutex reclaimMutex_;
+
+    std::mutex buffersMutex_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+
+    std::atomic<Batch*> readyBatches_;
+
+    std::mutex stopMutex_;
+    std::condition_variable stopCv_;
+    bool stopping_;
+    std::thread reclaimer_;
+
+    void lockForRequest() const;
+    ThreadBuffer* localBuffer();
+    bool reserveCredit(ThreadBuffer& buffer, size_t bytes);
+    void takeReadyBatches(std::vector<void*>& pointers);
+    void drainBuffers(std::vector<void*>& pointers, bool wait);
+    void releasePointers(std::vector<void*>& pointers);
+    void reclaimerLoop();
+};
+
+DeferredFreeAllocator* createDeferredFreeAllocator(Allocator* inner,
+                                                  size_t batchSize = DeferredFreeAllocator::DEFAULT_BATCH_SIZE,
+                                                  size_t maxPendingBytes = DeferredFreeAllocator::DEFAULT_MAX_PENDING_BYTES);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "allocator.h"
+
+class MallocAllocator : public Allocator {
+public:
+    explicit MallocAllocator(size_t capacity);
+    ~MallocAllocator() override = default;
+
+    void* alloc(size_t size) override;
+    void free(void* ptr) override;
+    const char* name() const override { return "System malloc"; }
+    size_t getUsedMemory() const override { return usedMemory_; }
+    size_t getTotalMemory() const override { return totalSize_; }
+    size_t getBlockSize(void* ptr) const override;
+
+private:
+    struct Header {
+        size_t size;
+        size_t padding;
+    };
+
+    size_t totalSize_;
+    size_t usedMemory_;
+};
+
+MallocAllocator* createMallocAllocator(void* realMemory, size_t memorySize);
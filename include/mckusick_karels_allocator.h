@@ -15,6 +15,7 @@ public:
     const char* name() const override { return "McKusick-Karels Allocator"; }
     size_t getUsedMemory() const override { return usedMemory_; }
     size_t getTotalMemory() const override { return totalSize_; }
+    size_t getBlockSize(void* ptr) const override;
 
 private:
     static constexpr size_t PAGE_SIZE = 4096;
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool cacheAvailable() const { return cacheFd_ >= 0; }
+    bool tlbAvailable() const { return tlbFd_ >= 0; }
+    void start();
+    void stop();
+    uint64_t cacheMisses() const { return cacheMisses_; }
+    uint64_t tlbMisses() const { return tlbMisses_; }
+
+private:
+    int leaderFd() const { return cacheFd_ >= 0 ? cacheFd_ : tlbFd_; }
+
+    int cacheFd_;
+    int tlbFd_;
+    uint64_t cacheMisses_;
+    uint64_t tlbMisses_;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "allocator.h"
+
+class TlsfAllocator : public Allocator {
+public:
+    static constexpr size_t DEFAULT_SL_LOG2 = 4;
+    static constexpr size_t MAX_SL_LOG2 = 5;
+
+    TlsfAllocator(void* memory, size_t size, size_t slLog2 = DEFAULT_SL_LOG2);
+    ~TlsfAllocator() override = default;
+
+    void* alloc(size_t size) override;
+    void free(void* ptr) override;
+    const char* name() const override { return "TLSF Allocator"; }
+    size_t getUsedMemory() const override { return usedMemory_; }
+    size_t getTotalMemory() const override { return totalSize_; }
+    size_t getBlockSize(void* ptr) const override;
+
+private:
+    static constexpr size_t ALIGN_LOG2 = 4;
+    static constexpr size_t ALIGN_SIZE = size_t(1) << ALIGN_LOG2;
+    static constexpr size_t BLOCK_FREE = 1;
+    static constexpr size_t PREV_FREE = 2;
+    static constexpr size_t FLAG_MASK = BLOCK_FREE | PREV_FREE;
+
+    struct BlockHeader {
+        BlockHeader* prevPhys;
+        size_t sizeAndFlags;
+        BlockHeader* nextFree;
+        BlockHeader* prevFree;
+    };
+
+    static constexpr size_t HEADER_SIZE = 2 * sizeof(size_t);
+    static constexpr size_t MIN_BLOCK_SIZE = sizeof(BlockHeader) - HEADER_SIZE;
+
+    size_t totalSize_;
+    size_t usedMemory_;
+    size_t slLog2_;
+    size_t slCount_;
+    size_t flShift_;
+    size_t flCount_;
+    size_t maxBlockSize_;
+    uintptr_t poolStart_;
+    uintptr_t poolEnd_;
+
+    uint32_t flBitmap_;
+    std::vector<uint32_t> slBitmaps_;
+    std::vector<BlockHeader*> freeLists_;
+
+    static size_t blockSize(const BlockHeader* block) { return block->sizeAndFlags & ~FLAG_MASK; }
+    static bool isFree(const BlockHeader* block) { return block->sizeAndFlags & BLOCK_FREE; }
+    static bool isPrevFree(const BlockHeader* block) { return block->sizeAndFlags & PREV_FREE; }
+    static void setSize(BlockHeader* block, size_t size);
+    static void setFree(BlockHeader* block, bool free);
+    static void setPrevFree(BlockHeader* block, bool free);
+    static BlockHeader* nextPhys(const BlockHeader* block);
+    static void* toUser(BlockHeader* block);
+    static BlockHeader* fromUser(void* ptr);
+
+    void mapping(size_t size, size_t& fl, size_t& sl) const;
+    void mappingSearch(size_t size, size_t& fl, size_t& sl) const;
+    BlockHeader* findSuitable(size_t& fl, size_t& sl) const;
+    void insertFree(BlockHeader* block);
+    void removeFree(BlockHeader* block);
+    void removeFree(BlockHeader* block, size_t fl, size_t sl);
+    void splitBlock(BlockHeader* block, size_t size);
+    BlockHeader* mergePrev(BlockHeader* block);
+    BlockHeader* mergeNext(BlockHeader* block);
+};
+
+TlsfAllocator* createTlsfAllocator(void* realMemory, size_t memorySize,
+                                   size_t slLog2 = TlsfAllocator::DEFAULT_SL_LOG2);
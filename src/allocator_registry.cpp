@@ -0,0 +1,28 @@
+#include "allocator_registry.h"
+
+#include "buddy_allocator.h"
+#include "mckusick_karels_allocator.h"
+#include "malloc_allocator.h"
+
+const std::vector<AllocatorEntry>& allocatorRegistry() {
+    static const std::vector<AllocatorEntry> registry = {
+        {"buddy", true, [](void* m, size_t s, const AllocatorOptions&) -> Allocator* { return createBuddyAllocator(m, s); }},
+        {"mk", true, [](void* m, size_t s, const AllocatorOptions&) -> Allocator* { return createMcKusickKarelsAllocator(m, s); }},
+        {"tlsf", true, [](void* m, size_t s, const AllocatorOptions& o) -> Allocator* {
+            return createTlsfAllocator(m, s, o.tlsfSlLog2);
+        }},
+        {"buddy-deferred", true, [](void* m, size_t s, const AllocatorOptions& o) -> Allocator* {
+            return createDeferredFreeAllocator(createBuddyAllocator(m, s), o.deferredBatchSize,
+                                               o.deferredMaxPendingBytes);
+        }},
+        {"malloc", false, [](void* m, size_t s, const AllocatorOptions&) -> Allocator* { return createMallocAllocator(m, s); }},
+    };
+    return registry;
+}
+
+const AllocatorEntry* findAllocator(const std::string& key) {
+    for (const AllocatorEntry& entry : allocatorRegistry()) {
+        if (key == entry.key) return &entry;
+    }
+    return nullptr;
+}
@@ -1,21 +1,318 @@
 #include "benchmark.h"
+#include "perf_counters.h"
 
 #include <iostream>
 #include <iomanip>
+#include <fstream>
+#include <sstream>
 #include <random>
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <unordered_set>
+
+namespace {
+
+constexpr size_t LABEL_WIDTH = 36;
+constexpr size_t MIN_CELL_WIDTH = 28;
+constexpr size_t LOCALITY_PASSES = 8;
+constexpr size_t PAGE_SIZE = 4096;
+
+struct Node {
+    Node* next;
+    uint64_t value;
+};
+
+volatile uint64_t localitySink;
+
+double tCritical95(size_t df) {
+    static const double table[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+    if (df == 0) return 0.0;
+    if (df <= sizeof(table) / sizeof(table[0])) return table[df - 1];
+    return 1.960;
+}
+
+template <typename TimePoint>
+double elapsedNs(TimePoint start, TimePoint end) {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+double percentile(std::vector<double>& samples, double q) {
+    if (samples.empty()) return 0.0;
+    size_t index = static_cast<size_t>(q * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+void sampleTailLatencies(Allocator* allocator,
+                         size_t numOperations,
+                         size_t minSize,
+                         size_t maxSize,
+                         uint32_t seed,
+                         BenchmarkResult& result) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<size_t> sizeDist(minSize, maxSize);
+
+    std::vector<void*> allocations;
+    allocations.reserve(numOperations);
+    std::vector<double> allocSamples;
+    allocSamples.reserve(numOperations);
+
+    for (size_t i = 0; i < numOperations; i++) {
+        size_t size = sizeDist(gen);
+        auto start = std::chrono::steady_clock::now();
+        void* ptr = allocator->alloc(size);
+        auto end = std::chrono::steady_clock::now();
+        allocSamples.push_back(elapsedNs(start, end));
+        if (ptr) allocations.push_back(ptr);
+    }
+
+    std::shuffle(allocations.begin(), allocations.end(), gen);
+
+    std::vector<double> freeSamples;
+    freeSamples.reserve(allocations.size());
+    for (void* ptr : allocations) {
+        auto start = std::chrono::steady_clock::now();
+        allocator->free(ptr);
+        auto end = std::chrono::steady_clock::now();
+        freeSamples.push_back(elapsedNs(start, end));
+    }
+
+    result.allocP99Ns = percentile(allocSamples, 0.99);
+    result.allocP999Ns = percentile(allocSamples, 0.999);
+    result.freeP99Ns = percentile(freeSamples, 0.99);
+    result.freeP999Ns = percentile(freeSamples, 0.999);
+}
+
+template <typename Result, typename Getter>
+MetricStats computeStats(const std::vector<Result>& runs, Getter get) {
+    MetricStats stats;
+    if (runs.empty()) return stats;
+
+    for (const Result& r : runs) stats.mean += get(r);
+    stats.mean /= runs.size();
+
+    if (runs.size() < 2) return stats;
+
+    double sq = 0.0;
+    for (const Result& r : runs) {
+        double d = get(r) - stats.mean;
+        sq += d * d;
+    }
+    stats.stddev = std::sqrt(sq / (runs.size() - 1));
+    stats.ci95 = tCritical95(runs.size() - 1) * stats.stddev / std::sqrt(static_cast<double>(runs.size()));
+    return stats;
+}
+
+template <typename Result, typename Run>
+bool collectRuns(const AllocatorEntry& entry, const BenchmarkConfig& config,
+                 Run run, std::vector<Result>& runs) {
+    void* memory = nullptr;
+    if (entry.usesPool) {
+        memory = std::aligned_alloc(4096, config.memorySize);
+        if (!memory) return false;
+    }
+
+    runs.reserve(config.repeats);
+    for (size_t i = 0; i <= config.repeats; i++) {
+        Allocator* allocator = entry.create(memory, config.memorySize, config.allocatorOptions);
+        Result result = run(allocator, config.seed + static_cast<uint32_t>(i));
+        delete allocator;
+        if (i > 0) runs.push_back(result);
+    }
+
+    std::free(memory);
+    return true;
+}
+
+size_t allocateLocalityObjects(Allocator* allocator, size_t numOperations,
+                               size_t minSize, size_t maxSize, uint32_t seed,
+                               std::vector<Node*>& nodes, std::vector<size_t>& sizes) {
+    std::uniform_int_distribution<size_t> sizeDist(std::max(minSize, sizeof(Node)),
+                                                   std::max(maxSize, sizeof(Node)));
+
+    std::mt19937 agingGen(seed ^ 0x9e3779b9u);
+    std::vector<void*> aging;
+    aging.reserve(numOperations / 2);
+    for (size_t i = 0; i < numOperations / 2; i++) {
+        void* ptr = allocator->alloc(sizeDist(agingGen));
+        if (ptr) aging.push_back(ptr);
+    }
+    std::shuffle(aging.begin(), aging.end(), agingGen);
+    for (void* ptr : aging) {
+        allocator->free(ptr);
+    }
+
+    std::mt19937 gen(seed);
+    size_t prefix = numOperations;
+    nodes.reserve(numOperations);
+    sizes.reserve(numOperations);
+    for (size_t i = 0; i < numOperations; i++) {
+        size_t size = sizeDist(gen);
+        void* ptr = allocator->alloc(size);
+        if (ptr) {
+            nodes.push_back(static_cast<Node*>(ptr));
+            sizes.push_back(size);
+        } else if (prefix == numOperations) {
+            prefix = i;
+        }
+    }
+    return prefix;
+}
+
+size_t displayWidth(const std::string& s) {
+    size_t width = 0;
+    for (unsigned char c : s) {
+        if ((c & 0xC0) != 0x80) width++;
+    }
+    return width;
+}
+
+std::string padLeft(const std::string& s, size_t width) {
+    size_t w = displayWidth(s);
+    return w >= width ? s : std::string(width - w, ' ') + s;
+}
+
+std::string padRight(const std::string& s, size_t width) {
+    size_t w = displayWidth(s);
+    return w >= width ? s : s + std::string(width - w, ' ');
+}
+
+std::string formatStats(const MetricStats& stats, double scale, const char* suffix) {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(2) << stats.mean * scale << suffix
+       << " ± " << stats.ci95 * scale << suffix;
+    return ss.str();
+}
+
+template <typename Summary, typename Getter>
+void printRow(const std::string& label, const std::vector<Summary>& summaries, size_t width,
+              Getter get, double scale = 1.0, const char* suffix = "") {
+    std::cout << padRight(label, LABEL_WIDTH);
+    for (const Summary& s : summaries) {
+        std::cout << " | " << padLeft(formatStats(get(s), scale, suffix), width);
+    }
+    std::cout << "\n";
+}
+
+template <typename Getter>
+void printCounterRow(const std::string& label, const std::vector<LocalitySummary>& summaries, size_t width,
+                     bool LocalitySummary::*available, Getter get) {
+    std::cout << padRight(label, LABEL_WIDTH);
+    for (const LocalitySummary& s : summaries) {
+        std::string cell = s.*available ? formatStats(get(s), 1.0, "") : "н/д";
+        std::cout << " | " << padLeft(cell, width);
+    }
+    std::cout << "\n";
+}
+
+template <typename Summary>
+size_t cellWidth(const std::vector<Summary>& summaries) {
+    size_t width = MIN_CELL_WIDTH;
+    for (const Summary& s : summaries) {
+        width = std::max(width, displayWidth(s.allocatorName));
+    }
+    return width;
+}
+
+template <typename Summary>
+void printHeader(const std::vector<Summary>& summaries, size_t width, const char* title) {
+    std::cout << "\n=============== " << title << " ===============\n\n";
+
+    std::cout << padRight("Метрика (среднее ± 95% ДИ)", LABEL_WIDTH);
+    for (const Summary& s : summaries) {
+        std::cout << " | " << padLeft(s.allocatorName, width);
+    }
+    std::cout << "\n" << std::string(LABEL_WIDTH + summaries.size() * (width + 3), '-') << "\n";
+}
+
+void writeNullJson(std::ostream& out, const char* name, bool last = false) {
+    out << "      \"" << name << "\": null" << (last ? "\n" : ",\n");
+}
+
+void writeCounterCsv(std::ostream& out, const MetricStats& stats, bool available) {
+    if (available) out << stats.mean;
+}
+
+void writeStatsJson(std::ostream& out, const char* name, const MetricStats& stats, bool last = false) {
+    out << "      \"" << name << "\": {\"mean\": " << stats.mean
+        << ", \"stddev\": " << stats.stddev
+        << ", \"ci95\": " << stats.ci95 << "}" << (last ? "\n" : ",\n");
+}
+
+void writeCounterJson(std::ostream& out, const char* name, const MetricStats& stats,
+                      bool available, bool last = false) {
+    if (available) writeStatsJson(out, name, stats, last);
+    else writeNullJson(out, name, last);
+}
+
+std::string jsonEscape(const std::string& s) {
+    std::string escaped;
+    for (char c : s) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+void writeConfigCsvHeader(std::ostream& out) {
+    out << "memory_size,num_operations,min_size,max_size,seed,tlsf_sl_log2,"
+        << "deferred_batch_size,deferred_max_pending_bytes,";
+}
+
+void writeConfigCsvFields(std::ostream& out, const BenchmarkConfig& config) {
+    out << config.memorySize << "," << config.numOperations << ","
+        << config.minSize << "," << config.maxSize << "," << config.seed << ","
+        << config.allocatorOptions.tlsfSlLog2 << ","
+        << config.allocatorOptions.deferredBatchSize << ","
+        << config.allocatorOptions.deferredMaxPendingBytes << ",";
+}
+
+bool parseNumber(const std::string& field, double& out) {
+    if (field.empty()) return false;
+    char* end = nullptr;
+    out = std::strtod(field.c_str(), &end);
+    return *end == '\0';
+}
+
+std::vector<std::string> splitCsv(const std::string& line) {
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, ',')) {
+        if (!field.empty() && field.back() == '\r') field.pop_back();
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+}
 
 BenchmarkResult Benchmark::runBenchmark(Allocator* allocator,
                                          size_t numOperations,
                                          size_t minSize,
                                          size_t maxSize) {
+    std::random_device rd;
+    return runBenchmark(allocator, numOperations, minSize, maxSize, rd());
+}
+
+BenchmarkResult Benchmark::runBenchmark(Allocator* allocator,
+                                         size_t numOperations,
+                                         size_t minSize,
+                                         size_t maxSize,
+                                         uint32_t seed) {
     BenchmarkResult result;
     result.allocatorName = allocator->name();
     result.successfulAllocs = 0;
     result.failedAllocs = 0;
     
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    std::mt19937 gen(seed);
     std::uniform_int_distribution<size_t> sizeDist(minSize, maxSize);
     
     std::vector<void*> allocations;
@@ -45,51 +342,494 @@ BenchmarkResult Benchmark::runBenchmark(Allocator* allocator,
     }
     auto freeEnd = std::chrono::high_resolution_clock::now();
     
-    auto allocDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(allocEnd - allocStart);
-    auto freeDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(freeEnd - freeStart);
-    
-    result.avgAllocTimeNs = static_cast<double>(allocDuration.count()) / numOperations;
-    result.avgFreeTimeNs = static_cast<double>(freeDuration.count()) / 
+    result.avgAllocTimeNs = elapsedNs(allocStart, allocEnd) / numOperations;
+    result.avgFreeTimeNs = elapsedNs(freeStart, freeEnd) /
                            (allocations.empty() ? 1 : allocations.size());
     
+    sampleTailLatencies(allocator, numOperations, minSize, maxSize, seed, result);
+    
     return result;
 }
 
-void Benchmark::comparePrint(const BenchmarkResult& r1, const BenchmarkResult& r2) {
-    std::cout << std::fixed << std::setprecision(2);
-std::cout << "\n=============== РЕЗУЛЬТАТЫ СРАВНЕНИЯ ===============\n\n";
+LocalityResult Benchmark::runLocality(Allocator* allocator,
+                                      size_t numOperations,
+                                      size_t minSize,
+                                      size_t maxSize,
+                                      uint32_t seed) {
+    LocalityResult result = {};
+    result.allocatorName = allocator->name();
+
+    std::vector<Node*> nodes;
+    std::vector<size_t> sizes;
+    allocateLocalityObjects(allocator, numOperations, minSize, maxSize, seed, nodes, sizes);
+
+    result.objects = nodes.size();
+    result.failedAllocs = numOperations - nodes.size();
+    if (nodes.empty()) return result;
 
-std::cout << std::fixed << std::setprecision(2);
+    std::unordered_set<uintptr_t> pages;
+    double strideSum = 0.0;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        uintptr_t addr = reinterpret_cast<uintptr_t>(nodes[i]);
+        for (uintptr_t page = addr / PAGE_SIZE; page <= (addr + sizes[i] - 1) / PAGE_SIZE; page++) {
+            pages.insert(page);
+        }
+        if (i > 0) {
+            uintptr_t prev = reinterpret_cast<uintptr_t>(nodes[i - 1]);
+            strideSum += static_cast<double>(addr > prev ? addr - prev : prev - addr);
+        }
+    }
+    result.pagesPerObject = static_cast<double>(pages.size()) / nodes.size();
+    result.avgStrideBytes = nodes.size() > 1 ? strideSum / (nodes.size() - 1) : 0.0;
 
-std::cout << std::left << std::setw(42) << "Метрика" << " | " 
-          << std::right << std::setw(20) << r1.allocatorName << " | " 
-          << std::setw(20) << r2.allocatorName << "\n";
+    PerfCounters counters;
+    result.cacheCountersAvailable = counters.cacheAvailable();
+    result.tlbCountersAvailable = counters.tlbAvailable();
+    double touches = static_cast<double>(nodes.size() * LOCALITY_PASSES);
+    uint64_t sink = 0;
+
+    counters.start();
+    auto writeStart = std::chrono::high_resolution_clock::now();
+    for (size_t pass = 0; pass < LOCALITY_PASSES; pass++) {
+        for (size_t i = 0; i < nodes.size(); i++) {
+            std::memset(nodes[i], static_cast<int>(pass + i), sizes[i]);
+        }
+    }
+    auto writeEnd = std::chrono::high_resolution_clock::now();
+    counters.stop();
 
-std::cout << std::string(81, '-') << "\n";
+    result.writeCacheMisses = counters.cacheMisses() / touches;
+    result.writeTlbMisses = counters.tlbMisses() / touches;
 
+    counters.start();
+    auto readStart = std::chrono::high_resolution_clock::now();
+    for (size_t pass = 0; pass < LOCALITY_PASSES; pass++) {
+        for (size_t i = 0; i < nodes.size(); i++) {
+            const uint64_t* words = reinterpret_cast<const uint64_t*>(nodes[i]);
+            for (size_t w = 0; w < sizes[i] / sizeof(uint64_t); w++) {
+                sink += words[w];
+            }
+        }
+    }
+    auto readEnd = std::chrono::high_resolution_clock::now();
+    counters.stop();
+
+    result.readCacheMisses = counters.cacheMisses() / touches;
+    result.readTlbMisses = counters.tlbMisses() / touches;
+
+    for (size_t i = 0; i < nodes.size(); i++) {
+        nodes[i]->next = i + 1 < nodes.size() ? nodes[i + 1] : nullptr;
+        nodes[i]->value = i;
+    }
 
-std::cout << std::left << std::setw(53) << "Ср. время выделения (нс)" << " | "
-          << std::right << std::setw(20) << r1.avgAllocTimeNs << " | "
-          << std::setw(20) << r2.avgAllocTimeNs << "\n";
+    counters.start();
+    auto chaseStart = std::chrono::high_resolution_clock::now();
+    for (size_t pass = 0; pass < LOCALITY_PASSES; pass++) {
+        for (const Node* node = nodes.front(); node; node = node->next) {
+            sink += node->value;
+        }
+    }
+    auto chaseEnd = std::chrono::high_resolution_clock::now();
+    counters.stop();
 
+    result.chaseCacheMisses = counters.cacheMisses() / touches;
+    result.chaseTlbMisses = counters.tlbMisses() / touches;
+    localitySink = sink;
 
-std::cout << std::left << std::setw(56) << "Ср. время освобождения (нс)" << " | "
-          << std::right << std::setw(20) << r1.avgFreeTimeNs << " | "
-          << std::setw(20) << r2.avgFreeTimeNs << "\n";
+    result.writeNsPerObject = elapsedNs(writeStart, writeEnd) / touches;
+    result.readNsPerObject = elapsedNs(readStart, readEnd) / touches;
+    result.chaseNsPerObject = elapsedNs(chaseStart, chaseEnd) / touches;
 
-std::cout << std::left << std::setw(54) << "Фактор использования" << " | "
-          << std::right << std::setw(19) << (r1.utilizationFactor * 100) << "%" << " | "
-          << std::setw(19) << (r2.utilizationFactor * 100) << "%\n";
+    for (Node* node : nodes) {
+        allocator->free(node);
+    }
+    return result;
+}
 
-std::cout << std::left << std::setw(52) << "Успешных выделений" << " | "
-          << std::right << std::setw(20) << r1.successfulAllocs << " | "
-          << std::setw(20) << r2.successfulAllocs << "\n";
+size_t Benchmark::fitLocalityOperations(const std::vector<const AllocatorEntry*>& entries,
+                                        const BenchmarkConfig& config) {
+    size_t ops = config.numOperations;
+    while (ops > 0) {
+        size_t fit = ops;
+        for (const AllocatorEntry* entry : entries) {
+            std::vector<size_t> prefixes;
+            if (!collectRuns(*entry, config, [&](Allocator* allocator, uint32_t seed) {
+                std::vector<Node*> nodes;
+                std::vector<size_t> sizes;
+                size_t prefix = allocateLocalityObjects(allocator, ops, config.minSize, config.maxSize,
+                                                        seed, nodes, sizes);
+                for (Node* node : nodes) {
+                    allocator->free(node);
+                }
+                return prefix;
+            }, prefixes)) return 0;
+            for (size_t prefix : prefixes) fit = std::min(fit, prefix);
+        }
+        if (fit == ops) return ops;
+        ops = fit;
+    }
+    return 0;
+}
 
+BenchmarkSummary Benchmark::runRepeated(const AllocatorEntry& entry, const BenchmarkConfig& config) {
+    std::vector<BenchmarkResult> runs;
+    collectRuns(entry, config, [&](Allocator* allocator, uint32_t seed) {
+        return runBenchmark(allocator, config.numOperations, config.minSize, config.maxSize, seed);
+    }, runs);
+    return summarize(entry.key, runs);
+}
 
-std::cout << std::left << std::setw(53) << "Неудачных выделений" << " | "
-          << std::right << std::setw(20) << r1.failedAllocs << " | "
-          << std::setw(20) << r2.failedAllocs << "\n";
+LocalitySummary Benchmark::runLocalityRepeated(const AllocatorEntry& entry, const BenchmarkConfig& config) {
+    std::vector<LocalityResult> runs;
+    collectRuns(entry, config, [&](Allocator* allocator, uint32_t seed) {
+        return runLocality(allocator, config.numOperations, config.minSize, config.maxSize, seed);
+    }, runs);
+    return summarizeLocality(entry.key, runs);
+}
 
-std::cout << std::string(81, '=') << "\n";
+BenchmarkSummary Benchmark::summarize(const std::string& key, const std::vector<BenchmarkResult>& runs) {
+    BenchmarkSummary summary;
+    summary.key = key;
+    summary.allocatorName = runs.empty() ? key : runs.front().allocatorName;
+    summary.runs = runs.size();
+    summary.allocTimeNs = computeStats(runs, [](const BenchmarkResult& r) { return r.avgAllocTimeNs; });
+    summary.freeTimeNs = computeStats(runs, [](const BenchmarkResult& r) { return r.avgFreeTimeNs; });
+    summary.allocP99Ns = computeStats(runs, [](const BenchmarkResult& r) { return r.allocP99Ns; });
+    summary.allocP999Ns = computeStats(runs, [](const BenchmarkResult& r) { return r.allocP999Ns; });
+    summary.freeP99Ns = computeStats(runs, [](const BenchmarkResult& r) { return r.freeP99Ns; });
+    summary.freeP999Ns = computeStats(runs, [](const BenchmarkResult& r) { return r.freeP999Ns; });
+    summary.utilizationFactor = computeStats(runs, [](const BenchmarkResult& r) { return r.utilizationFactor; });
+    summary.successfulAllocs = computeStats(runs, [](const BenchmarkResult& r) {
+        return static_cast<double>(r.successfulAllocs);
+    });
+    summary.failedAllocs = computeStats(runs, [](const BenchmarkResult& r) {
+        return static_cast<double>(r.failedAllocs);
+    });
+    return summary;
+}
 
+LocalitySummary Benchmark::summarizeLocality(const std::string& key, const std::vector<LocalityResult>& runs) {
+    LocalitySummary summary;
+    summary.key = key;
+    summary.allocatorName = runs.empty() ? key : runs.front().allocatorName;
+    summary.runs = runs.size();
+    summary.cacheCountersAvailable = !runs.empty() && std::all_of(runs.begin(), runs.end(),
+        [](const LocalityResult& r) { return r.cacheCountersAvailable; });
+    summary.tlbCountersAvailable = !runs.empty() && std::all_of(runs.begin(), runs.end(),
+        [](const LocalityResult& r) { return r.tlbCountersAvailable; });
+    summary.objects = computeStats(runs, [](const LocalityResult& r) { return static_cast<double>(r.objects); });
+    summary.writeNsPerObject = computeStats(runs, [](const LocalityResult& r) { return r.writeNsPerObject; });
+    summary.readNsPerObject = computeStats(runs, [](const LocalityResult& r) { return r.readNsPerObject; });
+    summary.chaseNsPerObject = computeStats(runs, [](const LocalityResult& r) { return r.chaseNsPerObject; });
+    summary.pagesPerObject = computeStats(runs, [](const LocalityResult& r) { return r.pagesPerObject; });
+    summary.avgStrideBytes = computeStats(runs, [](const LocalityResult& r) { return r.avgStrideBytes; });
+    summary.failedAllocs = computeStats(runs, [](const LocalityResult& r) { return static_cast<double>(r.failedAllocs); });
+    summary.writeCacheMisses = computeStats(runs, [](const LocalityResult& r) { return r.writeCacheMisses; });
+    summary.writeTlbMisses = computeStats(runs, [](const LocalityResult& r) { return r.writeTlbMisses; });
+    summary.readCacheMisses = computeStats(runs, [](const LocalityResult& r) { return r.readCacheMisses; });
+    summary.readTlbMisses = computeStats(runs, [](const LocalityResult& r) { return r.readTlbMisses; });
+    summary.chaseCacheMisses = computeStats(runs, [](const LocalityResult& r) { return r.chaseCacheMisses; });
+    summary.chaseTlbMisses = computeStats(runs, [](const LocalityResult& r) { return r.chaseTlbMisses; });
+    return summary;
+}
+
+void Benchmark::comparePrint(const std::vector<BenchmarkSummary>& summaries) {
+    size_t width = cellWidth(summaries);
+    size_t lineWidth = LABEL_WIDTH + summaries.size() * (width + 3);
+
+    printHeader(summaries, width, "РЕЗУЛЬТАТЫ СРАВНЕНИЯ");
+
+    printRow("Ср. время выделения (нс)", summaries, width,
+             [](const BenchmarkSummary& s) { return s.allocTimeNs; });
+    printRow("Ср. время освобождения (нс)", summaries, width,
+             [](const BenchmarkSummary& s) { return s.freeTimeNs; });
+    printRow("Выделение p99 (нс)", summaries, width,
+             [](const BenchmarkSummary& s) { return s.allocP99Ns; });
+    printRow("Выделение p99.9 (нс)", summaries, width,
+             [](const BenchmarkSummary& s) { return s.allocP999Ns; });
+    printRow("Освобождение p99 (нс)", summaries, width,
+             [](const BenchmarkSummary& s) { return s.freeP99Ns; });
+    printRow("Освобождение p99.9 (нс)", summaries, width,
+             [](const BenchmarkSummary& s) { return s.freeP999Ns; });
+    printRow("Фактор использования", summaries, width,
+             [](const BenchmarkSummary& s) { return s.utilizationFactor; }, 100.0, "%");
+    printRow("Успешных выделений", summaries, width,
+             [](const BenchmarkSummary& s) { return s.successfulAllocs; });
+    printRow("Неудачных выделений", summaries, width,
+             [](const BenchmarkSummary& s) { return s.failedAllocs; });
+
+    std::cout << std::string(lineWidth, '=') << "\n";
+}
+
+void Benchmark::comparePrint(const std::vector<LocalitySummary>& summaries) {
+    size_t width = cellWidth(summaries);
+    size_t lineWidth = LABEL_WIDTH + summaries.size() * (width + 3);
+
+    printHeader(summaries, width, "ЛОКАЛЬНОСТЬ ДОСТУПА");
+
+    printRow("Объектов", summaries, width,
+             [](const LocalitySummary& s) { return s.objects; });
+    printRow("Неудачных выделений", summaries, width,
+             [](const LocalitySummary& s) { return s.failedAllocs; });
+    printRow("Запись (нс/объект)", summaries, width,
+             [](const LocalitySummary& s) { return s.writeNsPerObject; });
+    printRow("Чтение (нс/объект)", summaries, width,
+             [](const LocalitySummary& s) { return s.readNsPerObject; });
+    printRow("Обход списка (нс/объект)", summaries, width,
+             [](const LocalitySummary& s) { return s.chaseNsPerObject; });
+    printRow("Страниц на объект", summaries, width,
+             [](const LocalitySummary& s) { return s.pagesPerObject; });
+    printRow("Ср. шаг адресов (байт)", summaries, width,
+             [](const LocalitySummary& s) { return s.avgStrideBytes; });
+    printCounterRow("Промахи кэша, запись (на объект)", summaries, width, &LocalitySummary::cacheCountersAvailable,
+                    [](const LocalitySummary& s) { return s.writeCacheMisses; });
+    printCounterRow("Промахи TLB, запись (на объект)", summaries, width, &LocalitySummary::tlbCountersAvailable,
+                    [](const LocalitySummary& s) { return s.writeTlbMisses; });
+    printCounterRow("Промахи кэша, чтение (на объект)", summaries, width, &LocalitySummary::cacheCountersAvailable,
+                    [](const LocalitySummary& s) { return s.readCacheMisses; });
+    printCounterRow("Промахи TLB, чтение (на объект)", summaries, width, &LocalitySummary::tlbCountersAvailable,
+                    [](const LocalitySummary& s) { return s.readTlbMisses; });
+    printCounterRow("Промахи кэша, список (на объект)", summaries, width, &LocalitySummary::cacheCountersAvailable,
+                    [](const LocalitySummary& s) { return s.chaseCacheMisses; });
+    printCounterRow("Промахи TLB, список (на объект)", summaries, width, &LocalitySummary::tlbCountersAvailable,
+                    [](const LocalitySummary& s) { return s.chaseTlbMisses; });
+
+    std::cout << std::string(lineWidth, '=') << "\n";
+}
+
+void Benchmark::writeJson(std::ostream& out, const BenchmarkConfig& config,
+                          const std::vector<BenchmarkSummary>& summaries) {
+    out << std::setprecision(6);
+    out << "{\n";
+    out << "  \"config\": {\"memorySize\": " << config.memorySize
+        << ", \"numOperations\": " << config.numOperations
+        << ", \"minSize\": " << config.minSize
+        << ", \"maxSize\": " << config.maxSize
+        << ", \"repeats\": " << config.repeats
+        << ", \"seed\": " << config.seed
+        << ", \"tlsfSlLog2\": " << config.allocatorOptions.tlsfSlLog2
+        << ", \"deferredBatchSize\": " << config.allocatorOptions.deferredBatchSize
+        << ", \"deferredMaxPendingBytes\": " << config.allocatorOptions.deferredMaxPendingBytes << "},\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < summaries.size(); i++) {
+        const BenchmarkSummary& s = summaries[i];
+        out << "    {\n";
+        out << "      \"key\": \"" << jsonEscape(s.key) << "\",\n";
+        out << "      \"name\": \"" << jsonEscape(s.allocatorName) << "\",\n";
+        out << "      \"runs\": " << s.runs << ",\n";
+        writeStatsJson(out, "avgAllocTimeNs", s.allocTimeNs);
+        writeStatsJson(out, "avgFreeTimeNs", s.freeTimeNs);
+        writeStatsJson(out, "allocP99Ns", s.allocP99Ns);
+        writeStatsJson(out, "allocP999Ns", s.allocP999Ns);
+        writeStatsJson(out, "freeP99Ns", s.freeP99Ns);
+        writeStatsJson(out, "freeP999Ns", s.freeP999Ns);
+        writeStatsJson(out, "utilizationFactor", s.utilizationFactor);
+        writeStatsJson(out, "successfulAllocs", s.successfulAllocs);
+        writeStatsJson(out, "failedAllocs", s.failedAllocs, true);
+        out << "    }" << (i + 1 < summaries.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+void Benchmark::writeJson(std::ostream& out, const BenchmarkConfig& config,
+                          const std::vector<LocalitySummary>& summaries) {
+    out << std::setprecision(6);
+    out << "{\n";
+    out << "  \"config\": {\"mode\": \"locality\", \"memorySize\": " << config.memorySize
+        << ", \"numOperations\": " << config.numOperations
+        << ", \"minSize\": " << config.minSize
+        << ", \"maxSize\": " << config.maxSize
+        << ", \"repeats\": " << config.repeats
+        << ", \"seed\": " << config.seed
+        << ", \"tlsfSlLog2\": " << config.allocatorOptions.tlsfSlLog2
+        << ", \"deferredBatchSize\": " << config.allocatorOptions.deferredBatchSize
+        << ", \"deferredMaxPendingBytes\": " << config.allocatorOptions.deferredMaxPendingBytes << "},\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < summaries.size(); i++) {
+        const LocalitySummary& s = summaries[i];
+        out << "    {\n";
+        out << "      \"key\": \"" << jsonEscape(s.key) << "\",\n";
+        out << "      \"name\": \"" << jsonEscape(s.allocatorName) << "\",\n";
+        out << "      \"runs\": " << s.runs << ",\n";
+        out << "      \"cacheCountersAvailable\": " << (s.cacheCountersAvailable ? "true" : "false") << ",\n";
+        out << "      \"tlbCountersAvailable\": " << (s.tlbCountersAvailable ? "true" : "false") << ",\n";
+        writeStatsJson(out, "objects", s.objects);
+        writeStatsJson(out, "writeNsPerObject", s.writeNsPerObject);
+        writeStatsJson(out, "readNsPerObject", s.readNsPerObject);
+        writeStatsJson(out, "chaseNsPerObject", s.chaseNsPerObject);
+        writeStatsJson(out, "pagesPerObject", s.pagesPerObject);
+        writeStatsJson(out, "avgStrideBytes", s.avgStrideBytes);
+        writeStatsJson(out, "failedAllocs", s.failedAllocs);
+        writeCounterJson(out, "writeCacheMisses", s.writeCacheMisses, s.cacheCountersAvailable);
+        writeCounterJson(out, "writeTlbMisses", s.writeTlbMisses, s.tlbCountersAvailable);
+        writeCounterJson(out, "readCacheMisses", s.readCacheMisses, s.cacheCountersAvailable);
+        writeCounterJson(out, "readTlbMisses", s.readTlbMisses, s.tlbCountersAvailable);
+        writeCounterJson(out, "chaseCacheMisses", s.chaseCacheMisses, s.cacheCountersAvailable);
+        writeCounterJson(out, "chaseTlbMisses", s.chaseTlbMisses, s.tlbCountersAvailable, true);
+        out << "    }" << (i + 1 < summaries.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+void Benchmark::writeCsv(std::ostream& out, const BenchmarkConfig& config,
+                         const std::vector<BenchmarkSummary>& summaries) {
+    out << std::setprecision(6);
+    writeConfigCsvHeader(out);
+    out << "key,name,runs,"
+        << "alloc_ns_mean,alloc_ns_ci95,free_ns_mean,free_ns_ci95,"
+        << "utilization_mean,utilization_ci95,successful_mean,failed_mean,"
+        << "alloc_p99_ns_mean,alloc_p999_ns_mean,free_p99_ns_mean,free_p999_ns_mean\n";
+    for (const BenchmarkSummary& s : summaries) {
+        writeConfigCsvFields(out, config);
+        out << s.key << "," << s.allocatorName << "," << s.runs << ","
+            << s.allocTimeNs.mean << "," << s.allocTimeNs.ci95 << ","
+            << s.freeTimeNs.mean << "," << s.freeTimeNs.ci95 << ","
+            << s.utilizationFactor.mean << "," << s.utilizationFactor.ci95 << ","
+            << s.successfulAllocs.mean << "," << s.failedAllocs.mean << ","
+            << s.allocP99Ns.mean << "," << s.allocP999Ns.mean << ","
+            << s.freeP99Ns.mean << "," << s.freeP999Ns.mean << "\n";
+    }
+}
+
+void Benchmark::writeCsv(std::ostream& out, const BenchmarkConfig& config,
+                         const std::vector<LocalitySummary>& summaries) {
+    out << std::setprecision(6);
+    writeConfigCsvHeader(out);
+    out << "key,name,runs,cache_counters,tlb_counters,objects_mean,failed_mean,"
+        << "write_ns_mean,write_ns_ci95,read_ns_mean,read_ns_ci95,chase_ns_mean,chase_ns_ci95,"
+        << "pages_per_object_mean,stride_bytes_mean,"
+        << "write_cache_miss_mean,write_tlb_miss_mean,read_cache_miss_mean,read_tlb_miss_mean,chase_cache_miss_mean,chase_tlb_miss_mean\n";
+    for (const LocalitySummary& s : summaries) {
+        writeConfigCsvFields(out, config);
+        out << s.key << "," << s.allocatorName << "," << s.runs << ","
+            << (s.cacheCountersAvailable ? 1 : 0) << "," << (s.tlbCountersAvailable ? 1 : 0) << ","
+            << s.objects.mean << "," << s.failedAllocs.mean << ","
+            << s.writeNsPerObject.mean << "," << s.writeNsPerObject.ci95 << ","
+            << s.readNsPerObject.mean << "," << s.readNsPerObject.ci95 << ","
+            << s.chaseNsPerObject.mean << "," << s.chaseNsPerObject.ci95 << ","
+            << s.pagesPerObject.mean << "," << s.avgStrideBytes.mean << ",";
+        writeCounterCsv(out, s.writeCacheMisses, s.cacheCountersAvailable);
+        out << ",";
+        writeCounterCsv(out, s.writeTlbMisses, s.tlbCountersAvailable);
+        out << ",";
+        writeCounterCsv(out, s.readCacheMisses, s.cacheCountersAvailable);
+        out << ",";
+        writeCounterCsv(out, s.readTlbMisses, s.tlbCountersAvailable);
+        out << ",";
+        writeCounterCsv(out, s.chaseCacheMisses, s.cacheCountersAvailable);
+        out << ",";
+        writeCounterCsv(out, s.chaseTlbMisses, s.tlbCountersAvailable);
+        out << "\n";
+    }
+}
+
+bool Benchmark::loadBaseline(const std::string& path, BenchmarkConfig& config,
+                             std::vector<BenchmarkSummary>& baseline) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    std::string line;
+    if (!std::getline(in, line)) return false;
+
+    std::map<std::string, size_t> columns;
+    std::vector<std::string> header = splitCsv(line);
+    for (size_t i = 0; i < header.size(); i++) columns[header[i]] = i;
+
+    for (const char* required : {"memory_size", "num_operations", "min_size", "max_size", "seed",
+                                 "tlsf_sl_log2", "key", "alloc_ns_mean", "free_ns_mean"}) {
+        if (!columns.count(required)) return false;
+    }
+
+    bool valid = true;
+    auto number = [&](const std::vector<std::string>& fields, const char* column) {
+        auto it = columns.find(column);
+        if (it == columns.end()) return 0.0;
+        double value = 0.0;
+        if (!parseNumber(fields[it->second], value)) valid = false;
+        return value;
+    };
+
+    baseline.clear();
+    while (std::getline(in, line)) {
+        if (line.empty() || line == "\r") continue;
+
+        std::vector<std::string> fields = splitCsv(line);
+        if (fields.size() != header.size()) return false;
+
+        BenchmarkConfig rowConfig;
+        rowConfig.memorySize = static_cast<size_t>(number(fields, "memory_size"));
+        rowConfig.numOperations = static_cast<size_t>(number(fields, "num_operations"));
+        rowConfig.minSize = static_cast<size_t>(number(fields, "min_size"));
+        rowConfig.maxSize = static_cast<size_t>(number(fields, "max_size"));
+        rowConfig.seed = static_cast<uint32_t>(number(fields, "seed"));
+        rowConfig.allocatorOptions.tlsfSlLog2 = static_cast<size_t>(number(fields, "tlsf_sl_log2"));
+        if (columns.count("deferred_batch_size")) {
+            rowConfig.allocatorOptions.deferredBatchSize =
+                static_cast<size_t>(number(fields, "deferred_batch_size"));
+        }
+        if (columns.count("deferred_max_pending_bytes")) {
+            rowConfig.allocatorOptions.deferredMaxPendingBytes =
+                static_cast<size_t>(number(fields, "deferred_max_pending_bytes"));
+        }
+        if (baseline.empty()) config = rowConfig;
+        else if (!sameWorkload(config, rowConfig)) return false;
+
+        BenchmarkSummary s;
+        s.key = fields[columns["key"]];
+        s.allocatorName = columns.count("name") ? fields[columns["name"]] : s.key;
+        s.runs = static_cast<size_t>(number(fields, "runs"));
+        s.allocTimeNs.mean = number(fields, "alloc_ns_mean");
+        s.allocTimeNs.ci95 = number(fields, "alloc_ns_ci95");
+        s.freeTimeNs.mean = number(fields, "free_ns_mean");
+        s.freeTimeNs.ci95 = number(fields, "free_ns_ci95");
+        s.utilizationFactor.mean = number(fields, "utilization_mean");
+        s.utilizationFactor.ci95 = number(fields, "utilization_ci95");
+        s.successfulAllocs.mean = number(fields, "successful_mean");
+        s.failedAllocs.mean = number(fields, "failed_mean");
+        s.allocP99Ns.mean = number(fields, "alloc_p99_ns_mean");
+        s.allocP999Ns.mean = number(fields, "alloc_p999_ns_mean");
+        s.freeP99Ns.mean = number(fields, "free_p99_ns_mean");
+        s.freeP999Ns.mean = number(fields, "free_p999_ns_mean");
+        if (!valid || s.key.empty()) return false;
+        baseline.push_back(s);
+    }
+    return !baseline.empty();
+}
+
+bool Benchmark::sameWorkload(const BenchmarkConfig& a, const BenchmarkConfig& b) {
+    return a.memorySize == b.memorySize &&
+           a.numOperations == b.numOperations &&
+           a.minSize == b.minSize &&
+           a.maxSize == b.maxSize &&
+           a.seed == b.seed &&
+           a.allocatorOptions.tlsfSlLog2 == b.allocatorOptions.tlsfSlLog2 &&
+           a.allocatorOptions.deferredBatchSize == b.allocatorOptions.deferredBatchSize &&
+           a.allocatorOptions.deferredMaxPendingBytes == b.allocatorOptions.deferredMaxPendingBytes;
+}
+
+std::vector<Regression> Benchmark::findRegressions(const std::vector<BenchmarkSummary>& current,
+                                                   const std::vector<BenchmarkSummary>& baseline,
+                                                   double threshold,
+                                                   std::vector<std::string>& missing) {
+    std::vector<Regression> regressions;
+    for (const BenchmarkSummary& cur : current) {
+        auto base = std::find_if(baseline.begin(), baseline.end(),
+                                 [&](const BenchmarkSummary& b) { return b.key == cur.key; });
+        if (base == baseline.end()) {
+            missing.push_back(cur.key);
+            continue;
+        }
+
+        auto check = [&](const char* metric, const MetricStats& now, const MetricStats& before) {
+            if (before.mean <= 0.0) return;
+            if (now.mean - now.ci95 > before.mean * (1.0 + threshold)) {
+                regressions.push_back({cur.key, metric, before.mean, now.mean});
+            }
+        };
+        check("avgAllocTimeNs", cur.allocTimeNs, base->allocTimeNs);
+        check("avgFreeTimeNs", cur.freeTimeNs, base->freeTimeNs);
+    }
+    return regressions;
 }
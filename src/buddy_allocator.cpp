@@ -186,6 +186,20 @@ void BuddyAllocator::free(void* ptr) {
     mergeBlock(block);
 }
 
+size_t BuddyAllocator::getBlockSize(void* ptr) const {
+    if (!ptr) return 0;
+
+    uintptr_t ptrAddr = reinterpret_cast<uintptr_t>(ptr);
+    uintptr_t baseAddr = reinterpret_cast<uintptr_t>(basePtr_);
+    if (ptrAddr < baseAddr + sizeof(Block) || ptrAddr >= baseAddr + totalSize_) return 0;
+
+    const Block* block = reinterpret_cast<const Block*>(
+        reinterpret_cast<uint8_t*>(ptr) - sizeof(Block));
+    if (block->level > maxLevel_ || block->isFree) return 0;
+
+    return levelToSize(block->level);
+}
+
 BuddyAllocator* createBuddyAllocator(void* realMemory, size_t memorySize) {
     return new BuddyAllocator(realMemory, memorySize);
 }
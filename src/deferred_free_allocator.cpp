@@ -0,0 +1,262 @@
+#include "deferred_free_allocator.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+constexpr auto RECLAIM_INTERVAL = std::chrono::milliseconds(1);
+constexpr auto MAX_RECLAIM_INTERVAL = std::chrono::milliseconds(64);
+
+std::atomic<uint64_t> nextAllocatorId{1};
+
+}
+
+struct DeferredFreeAllocator::ThreadBuffer {
+    std::mutex mutex;
+    std::vector<void*> pointers;
+    size_t credit = 0;
+    uint64_t owner = 0;
+    bool orphaned = false;
+};
+
+struct DeferredFreeAllocator::ThreadBuffers {
+    uint64_t cachedOwner = 0;
+    ThreadBuffer* cachedBuffer = nullptr;
+    std::vector<std::shared_ptr<ThreadBuffer>> owned;
+
+    ~ThreadBuffers() {
+        for (auto& buffer : owned) {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            buffer->orphaned = true;
+        }
+    }
+};
+
+thread_local DeferredFreeAllocator::ThreadBuffers DeferredFreeAllocator::threadBuffers_;
+
+DeferredFreeAllocator::DeferredFreeAllocator(Allocator* inner,
+                                             size_t batchSize,
+                                             size_t maxPendingBytes,
+                                             bool backgroundReclaimer)
+    : inner_(inner), name_(std::string(inner->name()) + " (deferred free)"),
+      batchSize_(std::max<size_t>(batchSize, 1)), maxPendingBytes_(maxPendingBytes),
+      creditChunk_(std::max<size_t>(maxPendingBytes / CREDIT_CHUNKS, 1)), id_(nextAllocatorId++), allocWaiters_(0), pendingBytes_(0), readyBatches_(nullptr), stopping_(false) {
+    if (backgroundReclaimer) {
+        reclaimer_ = std::thread(&DeferredFreeAllocator::reclaimerLoop, this);
+    }
+}
+
+DeferredFreeAllocator::~DeferredFreeAllocator() {
+    {
+        std::lock_guard<std::mutex> lock(stopMutex_);
+        stopping_ = true;
+    }
+    stopCv_.notify_all();
+    if (reclaimer_.joinable()) reclaimer_.join();
+
+    quiesce();
+    delete inner_;
+}
+
+void DeferredFreeAllocator::lockForRequest() const {
+    if (allocMutex_.try_lock()) return;
+
+    allocWaiters_.fetch_add(1, std::memory_order_relaxed);
+    allocMutex_.lock();
+    allocWaiters_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+DeferredFreeAllocator::ThreadBuffer* DeferredFreeAllocator::localBuffer() {
+    ThreadBuffers& local = threadBuffers_;
+    if (local.cachedOwner == id_) return local.cachedBuffer;
+
+    for (auto& buffer : local.owned) {
+        if (buffer->owner == id_) {
+            local.cachedOwner = id_;
+            local.cachedBuffer = buffer.get();
+            return local.cachedBuffer;
+        }
+    }
+
+    local.owned.erase(std::remove_if(local.owned.begin(), local.owned.end(),
+                                     [](const std::shared_ptr<ThreadBuffer>& b) { return b.use_count() == 1; }),
+                      local.owned.end());
+
+    auto buffer = std::make_shared<ThreadBuffer>();
+    buffer->owner = id_;
+    buffer->pointers.reserve(batchSize_);
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        buffers_.push_back(buffer);
+    }
+    local.owned.push_back(buffer);
+
+    local.cachedOwner = id_;
+    local.cachedBuffer = buffer.get();
+    return local.cachedBuffer;
+}
+
+bool DeferredFreeAllocator::reserveCredit(ThreadBuffer& buffer, size_t bytes) {
+    size_t needed = bytes - buffer.credit;
+    size_t grant;
+    size_t pending = pendingBytes_.load(std::memory_order_relaxed);
+    do {
+        size_t available = maxPendingBytes_ - pending;
+        if (available < needed) return false;
+        grant = std::min(available, std::max(needed, creditChunk_));
+    } while (!pendingBytes_.compare_exchange_weak(pending, pending + grant, std::memory_order_relaxed));
+    buffer.credit += grant;
+    return true;
+}
+
+void* DeferredFreeAllocator::alloc(size_t size) {
+    {
+        lockForRequest();
+        std::lock_guard<std::mutex> lock(allocMutex_, std::adopt_lock);
+        void* ptr = inner_->alloc(size);
+        if (ptr || pendingBytes_.load(std::memory_order_acquire) == 0) return ptr;
+    }
+
+    quiesce();
+
+    lockForRequest();
+    std::lock_guard<std::mutex> lock(allocMutex_, std::adopt_lock);
+    return inner_->alloc(size);
+}
+
+void DeferredFreeAllocator::free(void* ptr) {
+    if (!ptr) return;
+
+    size_t bytes = inner_->getBlockSize(ptr);
+    ThreadBuffer* buffer = localBuffer();
+    Batch* full = nullptr;
+    bool deferred;
+    {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        deferred = buffer->credit >= bytes || reserveCredit(*buffer, bytes);
+        if (deferred) {
+            buffer->credit -= bytes;
+            buffer->pointers.push_back(ptr);
+            if (buffer->pointers.size() >= batchSize_) {
+                full = new Batch{std::vector<void*>(), nullptr};
+                full->pointers.swap(buffer->pointers);
+                buffer->pointers.reserve(batchSize_);
+            }
+        }
+    }
+
+    if (!deferred) {
+        lockForRequest();
+        std::lock_guard<std::mutex> lock(allocMutex_, std::adopt_lock);
+        inner_->free(ptr);
+        return;
+    }
+
+    if (full) {
+        full->next = readyBatches_.load(std::memory_order_relaxed);
+        while (!readyBatches_.compare_exchange_weak(full->next, full,
+                                                    std::memory_order_release,
+                                                    std::memory_order_relaxed)) {}
+    }
+}
+
+size_t DeferredFreeAllocator::getUsedMemory() const {
+    lockForRequest();
+    std::lock_guard<std::mutex> lock(allocMutex_, std::adopt_lock);
+    return inner_->getUsedMemory();
+}
+
+void DeferredFreeAllocator::quiesce() {
+    std::lock_guard<std::mutex> lock(reclaimMutex_);
+    std::vector<void*> pointers;
+    takeReadyBatches(pointers);
+    drainBuffers(pointers, true);
+    releasePointers(pointers);
+}
+
+void DeferredFreeAllocator::takeReadyBatches(std::vector<void*>& pointers) {
+    Batch* batch = readyBatches_.exchange(nullptr, std::memory_order_acquire);
+    while (batch) {
+        pointers.insert(pointers.end(), batch->pointers.begin(), batch->pointers.end());
+        Batch* next = batch->next;
+        delete batch;
+        batch = next;
+    }
+}
+
+void DeferredFreeAllocator::drainBuffers(std::vector<void*>& pointers, bool wait) {
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    auto it = buffers_.begin();
+    while (it != buffers_.end()) {
+        ThreadBuffer* buffer = it->get();
+        bool orphaned;
+        size_t credit;
+        {
+            std::unique_lock<std::mutex> bufferLock(buffer->mutex, std::defer_lock);
+            if (wait) {
+                bufferLock.lock();
+            } else if (!bufferLock.try_lock()) {
+                ++it;
+                continue;
+            }
+            pointers.insert(pointers.end(), buffer->pointers.begin(), buffer->pointers.end());
+            buffer->pointers.clear();
+            credit = buffer->credit;
+            buffer->credit = 0;
+            orphaned = buffer->orphaned;
+        }
+        if (credit) pendingBytes_.fetch_sub(credit, std::memory_order_relaxed);
+        if (orphaned) it = buffers_.erase(it);
+        else ++it;
+    }
+}
+
+void DeferredFreeAllocator::releasePointers(std::vector<void*>& pointers) {
+    if (pointers.empty()) return;
+
+    std::sort(pointers.begin(), pointers.end(), std::less<void*>());
+
+    for (size_t start = 0; start < pointers.size(); start += RELEASE_CHUNK_SIZE) {
+        while (allocWaiters_.load(std::memory_order_relaxed) > 0) {
+            std::this_thread::yield();
+        }
+
+        size_t end = std::min(start + RELEASE_CHUNK_SIZE, pointers.size());
+        size_t bytes = 0;
+        {
+            std::lock_guard<std::mutex> lock(allocMutex_);
+            for (size_t i = start; i < end; i++) {
+                bytes += inner_->getBlockSize(pointers[i]);
+                inner_->free(pointers[i]);
+            }
+        }
+
+        pendingBytes_.fetch_sub(bytes, std::memory_order_release);
+    }
+}
+
+void DeferredFreeAllocator::reclaimerLoop() {
+    auto interval = RECLAIM_INTERVAL;
+    std::unique_lock<std::mutex> lock(stopMutex_);
+    while (!stopCv_.wait_for(lock, interval, [this] { return stopping_; })) {
+        lock.unlock();
+
+        bool idle;
+        {
+            std::lock_guard<std::mutex> reclaimLock(reclaimMutex_);
+            std::vector<void*> pointers;
+            takeReadyBatches(pointers);
+            idle = pointers.empty();
+            if (idle && interval == MAX_RECLAIM_INTERVAL) drainBuffers(pointers, false);
+            releasePointers(pointers);
+        }
+        interval = idle ? std::min(interval * 2, MAX_RECLAIM_INTERVAL) : RECLAIM_INTERVAL;
+
+        lock.lock();
+    }
+}
+
+DeferredFreeAllocator* createDeferredFreeAllocator(Allocator* inner, size_t batchSize, size_t maxPendingBytes) {
+    return new DeferredFreeAllocator(inner, batchSize, maxPendingBytes);
+}
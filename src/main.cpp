@@ -1,45 +1,265 @@
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
 #include <cstdlib>
+#include <cstdint>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
 
-#include "buddy_allocator.h"
-#include "mckusick_karels_allocator.h"
+#include "allocator_registry.h"
 #include "benchmark.h"
 
-int main() {
-    constexpr size_t MEMORY_SIZE = 64 * 1024 * 1024; 
-    constexpr size_t NUM_OPERATIONS = 100000;
-    constexpr size_t MIN_ALLOC_SIZE = 16;
-    constexpr size_t MAX_ALLOC_SIZE = 4096;
-    
-    void* memory1 = std::aligned_alloc(4096, MEMORY_SIZE);
-    void* memory2 = std::aligned_alloc(4096, MEMORY_SIZE);
-    
-    if (!memory1 || !memory2) {
-        std::cerr << "Ошибка: не удалось выделить память\n";
+namespace {
+
+struct Options {
+    BenchmarkConfig config;
+    std::vector<std::string> allocators = {"buddy", "buddy-deferred", "mk", "tlsf", "malloc"};
+    std::string mode = "throughput";
+    std::string format = "table";
+    std::string outputPath;
+    std::string baselinePath;
+    double threshold = 0.10;
+};
+
+void printUsage(const char* prog) {
+    std::cout << "Использование: " << prog << " [опции]\n"
+              << "  --memory-mb=N        размер пула памяти в MB (по умолчанию 64)\n"
+              << "  --ops=N              число операций выделения (по умолчанию 100000)\n"
+              << "  --min-size=N         минимальный размер аллокации (по умолчанию 16)\n"
+              << "  --max-size=N         максимальный размер аллокации (по умолчанию 4096)\n"
+              << "  --repeats=N          число повторов каждого прогона (по умолчанию 5)\n"
+              << "  --seed=N             зерно генератора размеров (по умолчанию 42)\n"
+              << "  --tlsf-sl-log2=N     log2 числа подклассов второго уровня TLSF, 0-"
+              << TlsfAllocator::MAX_SL_LOG2 << " (по умолчанию " << TlsfAllocator::DEFAULT_SL_LOG2 << ")\n"
+              << "  --deferred-batch=N   размер пакета отложенных освобождений buddy-deferred (по умолчанию "
+              << DeferredFreeAllocator::DEFAULT_BATCH_SIZE << ")\n"
+              << "  --deferred-max-pending-kb=N\n"
+              << "                       предел отложенной памяти buddy-deferred в KB (по умолчанию "
+              << DeferredFreeAllocator::DEFAULT_MAX_PENDING_BYTES / 1024 << ")\n"
+              << "  --allocators=a,b,... аллокаторы из реестра:";
+    for (const AllocatorEntry& entry : allocatorRegistry()) std::cout << " " << entry.key;
+    std::cout << "\n"
+              << "  --mode=M             throughput | locality (по умолчанию throughput)\n"
+              << "  --format=F           table | json | csv (по умолчанию table)\n"
+              << "  --output=PATH        файл для json/csv вместо stdout\n"
+              << "  --baseline=PATH      CSV базовой линии (вывод --format=csv)\n"
+              << "  --threshold=P        допустимое замедление в процентах (по умолчанию 10)\n";
+}
+
+bool parseSize(const std::string& value, size_t& out) {
+    if (value.empty() || !std::isdigit(static_cast<unsigned char>(value[0]))) return false;
+
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long v = std::strtoull(value.c_str(), &end, 10);
+    if (*end != '\0' || errno == ERANGE || v > SIZE_MAX) return false;
+    out = static_cast<size_t>(v);
+    return true;
+}
+
+bool parsePercent(const std::string& value, double& out) {
+    if (value.empty()) return false;
+
+    char* end = nullptr;
+    errno = 0;
+    double v = std::strtod(value.c_str(), &end);
+    if (*end != '\0' || errno == ERANGE || !std::isfinite(v) || v < 0.0) return false;
+    out = v / 100.0;
+    return true;
+}
+
+std::vector<std::string> splitList(const std::string& value) {
+    std::vector<std::string> items;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+bool parseOptions(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string key = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        size_t n = 0;
+        double d = 0.0;
+
+        if (key == "--help" || key == "-h") {
+            printUsage(argv[0]);
+            std::exit(0);
+        } else if (key == "--memory-mb" && parseSize(value, n) && n > 0 && n <= SIZE_MAX / (1024 * 1024)) {
+            opts.config.memorySize = n * 1024 * 1024;
+        } else if (key == "--ops" && parseSize(value, n) && n > 0) {
+            opts.config.numOperations = n;
+        } else if (key == "--min-size" && parseSize(value, n) && n > 0) {
+            opts.config.minSize = n;
+        } else if (key == "--max-size" && parseSize(value, n) && n > 0) {
+            opts.config.maxSize = n;
+        } else if (key == "--repeats" && parseSize(value, n) && n > 0) {
+            opts.config.repeats = n;
+        } else if (key == "--seed" && parseSize(value, n) && n <= UINT32_MAX) {
+            opts.config.seed = static_cast<uint32_t>(n);
+        } else if (key == "--tlsf-sl-log2" && parseSize(value, n) && n <= TlsfAllocator::MAX_SL_LOG2) {
+            opts.config.allocatorOptions.tlsfSlLog2 = n;
+        } else if (key == "--deferred-batch" && parseSize(value, n) && n > 0) {
+            opts.config.allocatorOptions.deferredBatchSize = n;
+        } else if (key == "--deferred-max-pending-kb" && parseSize(value, n) && n <= SIZE_MAX / 1024) {
+            opts.config.allocatorOptions.deferredMaxPendingBytes = n * 1024;
+        } else if (key == "--allocators" && !value.empty()) {
+            opts.allocators = splitList(value);
+        } else if (key == "--mode" && (value == "throughput" || value == "locality")) {
+            opts.mode = value;
+        } else if (key == "--format" && (value == "table" || value == "json" || value == "csv")) {
+            opts.format = value;
+        } else if (key == "--output" && !value.empty()) {
+            opts.outputPath = value;
+        } else if (key == "--baseline" && !value.empty()) {
+            opts.baselinePath = value;
+        } else if (key == "--threshold" && parsePercent(value, d)) {
+            opts.threshold = d;
+        } else {
+            std::cerr << "Ошибка: неверный аргумент " << arg << "\n";
+            return false;
+        }
+    }
+
+    if (opts.config.minSize > opts.config.maxSize) {
+        std::cerr << "Ошибка: --min-size больше --max-size\n";
+        return false;
+    }
+    if (opts.mode == "locality" && !opts.baselinePath.empty()) {
+        std::cerr << "Ошибка: --baseline поддерживается только в режиме throughput\n";
+        return false;
+    }
+    return true;
+}
+
+template <typename Summary>
+bool emitReport(const Options& opts, const std::vector<Summary>& summaries) {
+    if (opts.format == "table") {
+        Benchmark::comparePrint(summaries);
+        return true;
+    }
+
+    std::ofstream file;
+    if (!opts.outputPath.empty()) {
+        file.open(opts.outputPath);
+        if (!file) {
+            std::cerr << "Ошибка: не удалось открыть " << opts.outputPath << "\n";
+            return false;
+        }
+    }
+    std::ostream& out = file.is_open() ? file : std::cout;
+    if (opts.format == "json") Benchmark::writeJson(out, opts.config, summaries);
+    else Benchmark::writeCsv(out, opts.config, summaries);
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parseOptions(argc, argv, opts)) {
+        printUsage(argv[0]);
         return 1;
     }
-    
-    std::cout << "Тест аллокатора с  " << (MEMORY_SIZE / 1024 / 1024) 
-              << " MB пул мамяти\n";
-    std::cout << "Операции: " << NUM_OPERATIONS << "\n";
-    std::cout << "размеры аллокаций: " << MIN_ALLOC_SIZE << " - " << MAX_ALLOC_SIZE << " bytes\n";
-    
-
-    BuddyAllocator* buddy = createBuddyAllocator(memory1, MEMORY_SIZE);
-    McKusickKarelsAllocator* mck = createMcKusickKarelsAllocator(memory2, MEMORY_SIZE);
-    
-
-    BenchmarkResult buddyResult = Benchmark::runBenchmark(buddy, NUM_OPERATIONS, 
-                                                           MIN_ALLOC_SIZE, MAX_ALLOC_SIZE);
-    BenchmarkResult mckResult = Benchmark::runBenchmark(mck, NUM_OPERATIONS,
-                                                         MIN_ALLOC_SIZE, MAX_ALLOC_SIZE);
-    
-    Benchmark::comparePrint(buddyResult, mckResult);
-    
-    delete buddy;
-    delete mck;
-    std::free(memory1);
-    std::free(memory2);
-    
+
+    std::vector<const AllocatorEntry*> entries;
+    for (const std::string& key : opts.allocators) {
+        const AllocatorEntry* entry = findAllocator(key);
+        if (!entry) {
+            std::cerr << "Ошибка: неизвестный аллокатор " << key << "\n";
+            return 1;
+        }
+        entries.push_back(entry);
+    }
+
+    if (opts.mode == "locality") {
+        size_t ops = Benchmark::fitLocalityOperations(entries, opts.config);
+        if (ops == 0) {
+            std::cerr << "Ошибка: ни один объект не помещается во все выбранные аллокаторы\n";
+            return 1;
+        }
+        if (ops < opts.config.numOperations) {
+            std::cerr << "Предупреждение: число операций уменьшено с " << opts.config.numOperations
+                      << " до " << ops << ", чтобы все аллокаторы получили одинаковый набор объектов\n";
+            opts.config.numOperations = ops;
+        }
+    }
+
+    const BenchmarkConfig& config = opts.config;
+    bool table = opts.format == "table";
+
+    if (table) {
+        std::cout << "Тест аллокатора с  " << (config.memorySize / 1024 / 1024)
+                  << " MB пул мамяти\n";
+        std::cout << "Операции: " << config.numOperations
+                  << ", повторов: " << config.repeats
+                  << ", режим: " << opts.mode << "\n";
+        std::cout << "размеры аллокаций: " << config.minSize << " - " << config.maxSize << " bytes\n";
+    }
+
+    if (opts.mode == "locality") {
+        std::vector<LocalitySummary> summaries;
+        for (const AllocatorEntry* entry : entries) {
+            LocalitySummary summary = Benchmark::runLocalityRepeated(*entry, config);
+            if (summary.runs == 0) {
+                std::cerr << "Ошибка: не удалось выделить память\n";
+                return 1;
+            }
+            if (summary.failedAllocs.mean > 0.0) {
+                std::cerr << "Предупреждение: " << summary.allocatorName
+                          << " не разместил часть объектов, сравнение неточно\n";
+            }
+            summaries.push_back(summary);
+        }
+        return emitReport(opts, summaries) ? 0 : 1;
+    }
+
+    std::vector<BenchmarkSummary> summaries;
+    for (const AllocatorEntry* entry : entries) {
+        BenchmarkSummary summary = Benchmark::runRepeated(*entry, config);
+        if (summary.runs == 0) {
+            std::cerr << "Ошибка: не удалось выделить память\n";
+            return 1;
+        }
+        summaries.push_back(summary);
+    }
+
+    if (!emitReport(opts, summaries)) return 1;
+
+    if (!opts.baselinePath.empty()) {
+        BenchmarkConfig baselineConfig;
+        std::vector<BenchmarkSummary> baseline;
+        if (!Benchmark::loadBaseline(opts.baselinePath, baselineConfig, baseline)) {
+            std::cerr << "Ошибка: не удалось прочитать базовую линию " << opts.baselinePath << "\n";
+            return 1;
+        }
+        if (!Benchmark::sameWorkload(baselineConfig, config)) {
+            std::cerr << "Ошибка: параметры нагрузки базовой линии не совпадают с текущим прогоном\n";
+            return 1;
+        }
+
+        std::vector<std::string> missing;
+        std::vector<Regression> regressions = Benchmark::findRegressions(summaries, baseline,
+                                                                         opts.threshold, missing);
+        for (const std::string& key : missing) {
+            std::cerr << "Ошибка: нет строки базовой линии для аллокатора " << key << "\n";
+        }
+        if (!missing.empty()) return 1;
+
+        for (const Regression& r : regressions) {
+            std::cerr << "Регрессия: " << r.key << " " << r.metric << " "
+                      << r.baseline << " -> " << r.current << "\n";
+        }
+        if (!regressions.empty()) return 2;
+    }
+
     return 0;
 }
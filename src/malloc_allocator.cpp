@@ -0,0 +1,36 @@
+#include "malloc_allocator.h"
+
+#include <cstdlib>
+
+MallocAllocator::MallocAllocator(size_t capacity)
+    : totalSize_(capacity), usedMemory_(0) {}
+
+void* MallocAllocator::alloc(size_t size) {
+    if (size == 0) return nullptr;
+    if (usedMemory_ + size > totalSize_) return nullptr;
+
+    Header* header = static_cast<Header*>(std::malloc(sizeof(Header) + size));
+    if (!header) return nullptr;
+
+    header->size = size;
+    usedMemory_ += size;
+    return header + 1;
+}
+
+void MallocAllocator::free(void* ptr) {
+    if (!ptr) return;
+
+    Header* header = static_cast<Header*>(ptr) - 1;
+    usedMemory_ -= header->size;
+    std::free(header);
+}
+
+size_t MallocAllocator::getBlockSize(void* ptr) const {
+    if (!ptr) return 0;
+    return (static_cast<Header*>(ptr) - 1)->size;
+}
+
+MallocAllocator* createMallocAllocator(void* realMemory, size_t memorySize) {
+    (void)realMemory;
+    return new MallocAllocator(memorySize);
+}
@@ -205,7 +205,7 @@ void McKusickKarelsAllocator::freeLarge(LargeBlock* block) {
     
     if (pageIndex + numPages > pageCount_) return;
     
-    for (size_t i = 0; i < numPages; i++) {
+    for (size_t i = numPages; i-- > 0;) {
         PageDescriptor* page = &pageDescriptors_[pageIndex + i];
         page->bucketIndex = SIZE_MAX;
         page->allocCount = 0;
@@ -237,6 +237,21 @@ void McKusickKarelsAllocator::free(void* ptr) {
     }
 }
 
+size_t McKusickKarelsAllocator::getBlockSize(void* ptr) const {
+    if (!ptr) return 0;
+
+    PageDescriptor* page = getPageDescriptor(ptr);
+    if (!page) return 0;
+
+    if (page->bucketIndex == SIZE_MAX - 1) {
+        const LargeBlock* block = reinterpret_cast<const LargeBlock*>(
+            reinterpret_cast<uint8_t*>(ptr) - sizeof(LargeBlock));
+        return block->size;
+    }
+    if (page->bucketIndex < NUM_BUCKETS) return bucketToSize(page->bucketIndex);
+    return 0;
+}
+
 McKusickKarelsAllocator* createMcKusickKarelsAllocator(void* realMemory, size_t memorySize) {
     return new McKusickKarelsAllocator(realMemory, memorySize);
 }
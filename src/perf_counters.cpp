@@ -0,0 +1,89 @@
+#include "perf_counters.h"
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+struct GroupReading {
+    uint64_t count;
+    uint64_t timeEnabled;
+    uint64_t timeRunning;
+    uint64_t values[2];
+};
+
+int openCounter(uint32_t type, uint64_t config, int groupFd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = groupFd < 0 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP |
+                       PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+}
+
+}
+
+PerfCounters::PerfCounters()
+    : cacheFd_(-1), tlbFd_(-1), cacheMisses_(0), tlbMisses_(0) {
+    cacheFd_ = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, -1);
+    tlbFd_ = openCounter(PERF_TYPE_HW_CACHE,
+                         PERF_COUNT_HW_CACHE_DTLB |
+                         (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+                         cacheFd_);
+}
+
+PerfCounters::~PerfCounters() {
+    if (cacheFd_ >= 0) close(cacheFd_);
+    if (tlbFd_ >= 0) close(tlbFd_);
+}
+
+void PerfCounters::start() {
+    int leader = leaderFd();
+    if (leader < 0) return;
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void PerfCounters::stop() {
+    int leader = leaderFd();
+    if (leader < 0) return;
+    ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    cacheMisses_ = 0;
+    tlbMisses_ = 0;
+
+    size_t events = (cacheFd_ >= 0 ? 1 : 0) + (tlbFd_ >= 0 ? 1 : 0);
+    GroupReading reading;
+    ssize_t expected = static_cast<ssize_t>(3 * sizeof(uint64_t) + events * sizeof(uint64_t));
+    if (read(leader, &reading, sizeof(reading)) != expected) return;
+    if (reading.count != events || reading.timeRunning == 0) return;
+
+    double scale = static_cast<double>(reading.timeEnabled) / reading.timeRunning;
+    size_t index = 0;
+    if (cacheFd_ >= 0) cacheMisses_ = static_cast<uint64_t>(reading.values[index++] * scale);
+    if (tlbFd_ >= 0) tlbMisses_ = static_cast<uint64_t>(reading.values[index++] * scale);
+}
+
+#else
+
+PerfCounters::PerfCounters()
+    : cacheFd_(-1), tlbFd_(-1), cacheMisses_(0), tlbMisses_(0) {}
+
+PerfCounters::~PerfCounters() = default;
+
+void PerfCounters::start() {}
+
+void PerfCounters::stop() {}
+
+#endif
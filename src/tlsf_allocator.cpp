@@ -0,0 +1,245 @@
+#include "tlsf_allocator.h"
+
+#include <algorithm>
+
+namespace {
+
+size_t findLastSet(size_t x) {
+    return sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(static_cast<unsigned long long>(x));
+}
+
+size_t findFirstSet(uint32_t x) {
+    return static_cast<size_t>(__builtin_ctz(x));
+}
+
+}
+
+TlsfAllocator::TlsfAllocator(void* memory, size_t size, size_t slLog2)
+    : totalSize_(size), usedMemory_(0),
+      slLog2_(std::min(slLog2, MAX_SL_LOG2)),
+      flCount_(0), maxBlockSize_(0), poolStart_(0), poolEnd_(0), flBitmap_(0) {
+
+    slCount_ = size_t(1) << slLog2_;
+    flShift_ = slLog2_ + ALIGN_LOG2;
+
+    uintptr_t start = reinterpret_cast<uintptr_t>(memory);
+    uintptr_t end = start + size;
+    start = (start + ALIGN_SIZE - 1) & ~(ALIGN_SIZE - 1);
+    end &= ~(ALIGN_SIZE - 1);
+
+    if (end <= start || end - start < 2 * HEADER_SIZE + MIN_BLOCK_SIZE) return;
+
+    maxBlockSize_ = std::min(end - start - 2 * HEADER_SIZE,
+                             (size_t(1) << (flShift_ + 31)) - ALIGN_SIZE);
+    if (maxBlockSize_ < (size_t(1) << flShift_)) flCount_ = 1;
+    else flCount_ = findLastSet(maxBlockSize_) - flShift_ + 2;
+    poolStart_ = start;
+    poolEnd_ = end;
+
+    slBitmaps_.resize(flCount_, 0);
+    freeLists_.resize(flCount_ * slCount_, nullptr);
+
+    BlockHeader* block = reinterpret_cast<BlockHeader*>(start);
+    block->prevPhys = nullptr;
+    block->sizeAndFlags = 0;
+    setSize(block, maxBlockSize_);
+
+    BlockHeader* sentinel = nextPhys(block);
+    sentinel->prevPhys = block;
+    sentinel->sizeAndFlags = 0;
+
+    setFree(block, true);
+    setPrevFree(sentinel, true);
+    insertFree(block);
+}
+
+void TlsfAllocator::setSize(BlockHeader* block, size_t size) {
+    block->sizeAndFlags = size | (block->sizeAndFlags & FLAG_MASK);
+}
+
+void TlsfAllocator::setFree(BlockHeader* block, bool free) {
+    if (free) block->sizeAndFlags |= BLOCK_FREE;
+    else block->sizeAndFlags &= ~BLOCK_FREE;
+}
+
+void TlsfAllocator::setPrevFree(BlockHeader* block, bool free) {
+    if (free) block->sizeAndFlags |= PREV_FREE;
+    else block->sizeAndFlags &= ~PREV_FREE;
+}
+
+TlsfAllocator::BlockHeader* TlsfAllocator::nextPhys(const BlockHeader* block) {
+    return reinterpret_cast<BlockHeader*>(
+        reinterpret_cast<uintptr_t>(block) + HEADER_SIZE + blockSize(block));
+}
+
+void* TlsfAllocator::toUser(BlockHeader* block) {
+    return reinterpret_cast<uint8_t*>(block) + HEADER_SIZE;
+}
+
+TlsfAllocator::BlockHeader* TlsfAllocator::fromUser(void* ptr) {
+    return reinterpret_cast<BlockHeader*>(static_cast<uint8_t*>(ptr) - HEADER_SIZE);
+}
+
+void TlsfAllocator::mapping(size_t size, size_t& fl, size_t& sl) const {
+    if (size < (size_t(1) << flShift_)) {
+        fl = 0;
+        sl = size >> ALIGN_LOG2;
+    } else {
+        size_t msb = findLastSet(size);
+        sl = (size >> (msb - slLog2_)) ^ slCount_;
+        fl = msb - flShift_ + 1;
+    }
+}
+
+void TlsfAllocator::mappingSearch(size_t size, size_t& fl, size_t& sl) const {
+    if (size >= (size_t(1) << flShift_)) {
+        size += (size_t(1) << (findLastSet(size) - slLog2_)) - 1;
+    }
+    mapping(size, fl, sl);
+}
+
+TlsfAllocator::BlockHeader* TlsfAllocator::findSuitable(size_t& fl, size_t& sl) const {
+    if (fl >= flCount_) return nullptr;
+
+    uint32_t slMap = slBitmaps_[fl] & (~uint32_t(0) << sl);
+    if (!slMap) {
+        if (fl + 1 >= 32) return nullptr;
+        uint32_t flMap = flBitmap_ & (~uint32_t(0) << (fl + 1));
+        if (!flMap) return nullptr;
+
+        fl = findFirstSet(flMap);
+        slMap = slBitmaps_[fl];
+    }
+    sl = findFirstSet(slMap);
+    return freeLists_[fl * slCount_ + sl];
+}
+
+void TlsfAllocator::insertFree(BlockHeader* block) {
+    size_t fl, sl;
+    mapping(blockSize(block), fl, sl);
+
+    BlockHeader*& head = freeLists_[fl * slCount_ + sl];
+    block->nextFree = head;
+    block->prevFree = nullptr;
+    if (head) head->prevFree = block;
+    head = block;
+
+    flBitmap_ |= uint32_t(1) << fl;
+    slBitmaps_[fl] |= uint32_t(1) << sl;
+}
+
+void TlsfAllocator::removeFree(BlockHeader* block) {
+    size_t fl, sl;
+    mapping(blockSize(block), fl, sl);
+    removeFree(block, fl, sl);
+}
+
+void TlsfAllocator::removeFree(BlockHeader* block, size_t fl, size_t sl) {
+    BlockHeader*& head = freeLists_[fl * slCount_ + sl];
+
+    if (block->prevFree) block->prevFree->nextFree = block->nextFree;
+    else head = block->nextFree;
+    if (block->nextFree) block->nextFree->prevFree = block->prevFree;
+
+    block->nextFree = nullptr;
+    block->prevFree = nullptr;
+
+    if (!head) {
+        slBitmaps_[fl] &= ~(uint32_t(1) << sl);
+        if (!slBitmaps_[fl]) flBitmap_ &= ~(uint32_t(1) << fl);
+    }
+}
+
+void TlsfAllocator::splitBlock(BlockHeader* block, size_t size) {
+    size_t current = blockSize(block);
+    if (current < size + HEADER_SIZE + MIN_BLOCK_SIZE) return;
+
+    setSize(block, size);
+
+    BlockHeader* remainder = nextPhys(block);
+    remainder->prevPhys = block;
+    remainder->sizeAndFlags = 0;
+    setSize(remainder, current - size - HEADER_SIZE);
+    setFree(remainder, true);
+
+    BlockHeader* next = nextPhys(remainder);
+    next->prevPhys = remainder;
+    setPrevFree(next, true);
+
+    insertFree(remainder);
+}
+
+TlsfAllocator::BlockHeader* TlsfAllocator::mergePrev(BlockHeader* block) {
+    if (!isPrevFree(block)) return block;
+
+    BlockHeader* prev = block->prevPhys;
+    removeFree(prev);
+    setSize(prev, blockSize(prev) + HEADER_SIZE + blockSize(block));
+    nextPhys(prev)->prevPhys = prev;
+    return prev;
+}
+
+TlsfAllocator::BlockHeader* TlsfAllocator::mergeNext(BlockHeader* block) {
+    BlockHeader* next = nextPhys(block);
+    if (!isFree(next)) return block;
+
+    removeFree(next);
+    setSize(block, blockSize(block) + HEADER_SIZE + blockSize(next));
+    nextPhys(block)->prevPhys = block;
+    return block;
+}
+
+void* TlsfAllocator::alloc(size_t size) {
+    if (size == 0 || flCount_ == 0) return nullptr;
+    if (size > maxBlockSize_) return nullptr;
+
+    size = std::max((size + ALIGN_SIZE - 1) & ~(ALIGN_SIZE - 1), MIN_BLOCK_SIZE);
+
+    size_t fl, sl;
+    mappingSearch(size, fl, sl);
+    BlockHeader* block = findSuitable(fl, sl);
+    if (!block) return nullptr;
+
+    removeFree(block, fl, sl);
+    splitBlock(block, size);
+
+    setFree(block, false);
+    setPrevFree(nextPhys(block), false);
+
+    usedMemory_ += blockSize(block) + HEADER_SIZE;
+    return toUser(block);
+}
+
+void TlsfAllocator::free(void* ptr) {
+    if (!ptr) return;
+
+    uintptr_t ptrAddr = reinterpret_cast<uintptr_t>(ptr);
+    if (ptrAddr < poolStart_ + HEADER_SIZE || ptrAddr >= poolEnd_ - HEADER_SIZE) return;
+
+    BlockHeader* block = fromUser(ptr);
+    if (isFree(block)) return;
+
+    usedMemory_ -= blockSize(block) + HEADER_SIZE;
+
+    setFree(block, true);
+    block = mergePrev(block);
+    block = mergeNext(block);
+
+    setPrevFree(nextPhys(block), true);
+    insertFree(block);
+}
+
+size_t TlsfAllocator::getBlockSize(void* ptr) const {
+    if (!ptr) return 0;
+
+    uintptr_t ptrAddr = reinterpret_cast<uintptr_t>(ptr);
+    if (ptrAddr < poolStart_ + HEADER_SIZE || ptrAddr >= poolEnd_ - HEADER_SIZE) return 0;
+
+    const BlockHeader* block = fromUser(ptr);
+    if (isFree(block)) return 0;
+    return blockSize(block) + HEADER_SIZE;
+}
+
+TlsfAllocator* createTlsfAllocator(void* realMemory, size_t memorySize, size_t slLog2) {
+    return new TlsfAllocator(realMemory, memorySize, slLog2);
+}